@@ -0,0 +1,212 @@
+#ifndef AGG_H
+#define AGG_H
+
+#include <functional>
+#include <mutex>
+#include "heapfile.h"
+
+enum AggFunc { COUNTAGG, SUMAGG, MINAGG, MAXAGG };	// aggregate functions
+
+// an attribute of a record: the bytes [offset, offset+length), of
+// type type
+struct AggAttr
+{
+  int		offset;
+  int		length;
+  Datatype	type;
+};
+
+// an aggregate function over an attribute.  COUNTAGG counts the
+// records of a group and has no attribute; SUMAGG takes an INTEGER or
+// FLOAT attribute, MINAGG and MAXAGG any attribute
+struct AggSpec
+{
+  AggFunc	func;
+  AggAttr	attr;
+};
+
+// COUNT, SUM, MIN and MAX of an INTEGER or FLOAT attribute over some
+// records, computed together.  start from an AggPartial of zeros; min
+// and max are set once cnt is not 0
+struct AggPartial
+{
+  long long	cnt;
+  long long	sum;		// INTEGER attribute
+  double	fsum;		// FLOAT attribute
+  double	min;
+  double	max;
+};
+
+// add the partial aggregates from to into
+void mergePartial(AggPartial & into, const AggPartial & from);
+
+// add the partial aggregates of the INTEGER or FLOAT attribute attr
+// over the records on page to part.  the attribute values are gathered
+// in batches and each batch goes through a SIMD kernel, so no Record is
+// made.  records too short to hold the attribute are left out, and
+// large records as well, which are counted in skipped.  returns
+// BADAGGPARM for any other attribute
+const Status aggregatePage(const Page* page, const AggAttr & attr,
+			   AggPartial & part, int & skipped);
+
+// aggregate the attribute attr of the records returned by scan into
+// part, page by page with aggregatePage.  large records are read
+// one by one, as are the records of a filtered scan, whose values go
+// through the same kernels.  the scan is run to its end
+const Status aggregateScan(HeapFileScan & scan, const AggAttr & attr,
+			   AggPartial & part);
+
+// Hash aggregation (GROUP BY) of the records returned by a HeapFileScan
+// on the groupCnt attributes groupBy[], computing the aggCnt aggregates
+// aggs[] of every group.  Records too short to hold all of these
+// attributes are left out.  With no group-by attributes the records
+// make up a single group.
+//
+// next() returns a record per group: its group-by attributes back to
+// back, then the aggregates at getAggOffset(i).  A COUNTAGG, and a
+// SUMAGG of an INTEGER attribute, is a long long, a SUMAGG of a FLOAT
+// attribute a double, and a MINAGG or MAXAGG the attribute itself.  The
+// groups come in no particular order.
+//
+// The groups are kept in a flat hash table: fixed-size entries of the
+// group key and the running aggregates, stored back to back, and an
+// open addressing array of (hash, entry) slots at most half full, all
+// in a workspace of about maxPages*PAGESIZE bytes.  When a record of a
+// new group does not fit, the entries are spilled to fanOut temporary
+// heap files by the high bits of the hash, partial aggregates that are
+// merged later, and the table starts over empty.  Every partition is
+// then aggregated in turn, with a hash function of its own, and
+// partitioned again should it still not fit.
+//
+// The records can also be handed in one at a time, as by an operator of
+// a query plan (see exec.h).  A heap file can also be aggregated by
+// several threads that take its pages from a shared PageCursor.  Every
+// thread aggregates into a table of its own of maxPages/threads pages,
+// spilling as above, and the tables are then merged into that of the
+// first thread, so that together they stay within maxPages pages.
+
+class HashAggregate {
+ public:
+  // aggregate the records of input.  the scan is run to its end
+  HashAggregate(HeapFileScan & input,
+		const AggAttr groupBy[],
+		const int groupCnt,
+		const AggSpec aggs[],
+		const int aggCnt,
+		const int maxPages,
+		Status & status);
+
+  // aggregate all records of the heap file fileName with threads
+  // threads
+  HashAggregate(const string & fileName,
+		const AggAttr groupBy[],
+		const int groupCnt,
+		const AggSpec aggs[],
+		const int aggCnt,
+		const int maxPages,
+		const int threads,
+		Status & status);
+
+  // aggregate the records handed to add, one at a time, until finish
+  HashAggregate(const AggAttr groupBy[],
+		const int groupCnt,
+		const AggSpec aggs[],
+		const int aggCnt,
+		const int maxPages,
+		Status & status);
+
+  // destroys the spill files that are left
+  ~HashAggregate();
+
+  // add a record to an aggregation made with the constructor above
+  const Status add(const Record & rec);
+
+  // end the records of add.  next may then be called
+  const Status finish();
+
+  // return the record of the next group.  it is valid until the next
+  // call.  returns FILEEOF after the last group
+  const Status next(Record & rec);
+
+  // length of the records returned by next, and where aggregate i is
+  const int getResultLen() const { return resultLen; }
+  const int getAggOffset(const int i) const { return aggOffset[i]; }
+
+  // number of spilled partitions aggregated, 0 if the groups fit
+  const int getPartitionCnt() const { return partitionCnt; }
+
+ private:
+  struct Slot {
+    unsigned	hash;
+    int		entry;		// -1 if free
+  };
+
+  // a flat hash table of at most cap entries
+  struct Table {
+    vector<char> entries;
+    vector<Slot> slots;
+    int		cnt;
+    int		cap;
+  };
+
+  // spill files of partial aggregates to be merged, and the level of
+  // partitioning they come from
+  struct Task {
+    vector<string> files;
+    int		depth;
+  };
+
+  vector<AggAttr> groupBy;
+  vector<AggSpec> aggs;
+  int		keyLen;		// group key: the group-by attributes
+  vector<int>	stateOffset;	// running aggregate i in an entry
+  int		entrySize;
+  int		resultLen;
+  vector<int>	aggOffset;
+  int		threads;
+  int		fanOut;
+
+  Table		table;
+  int		outNext;	// next entry of table returned by next
+  vector<char>	result;
+
+  int		aggNo;		// names the spill files of this aggregation
+  int		fileNo;
+  mutex		spillLock;	// guards fileNo and spilled
+  bool		spilled;	// some entries went to spill files
+  vector<Task>	tasks;
+  int		partitionCnt;
+
+  vector<char>	entry;		// of the record handed to add
+  vector<vector<string> > addParts;	// spill files of add
+
+  const Status init(const AggAttr groupBy_[], const int groupCnt,
+		    const AggSpec aggs_[], const int aggCnt,
+		    const int maxPages, const int threads_);
+  void initTable(Table & t, const int bytes) const;
+  void clearTable(Table & t) const;
+
+  // the entry of a single record in entry, false if the record is
+  // too short
+  const bool makeEntry(const Record & rec, char* entry) const;
+  const unsigned hash(const char* entry, const int depth) const;
+
+  // merge the entry into the table, false if its group is new and the
+  // table is full
+  const bool add(Table & t, const char* entry, const unsigned h) const;
+  void merge(char* state, const char* from) const;
+
+  // write the entries of t to spill files, one for each partition that
+  // has any, adding them to parts, and empty t
+  const Status flush(Table & t, const int depth, vector<vector<string> > & parts);
+  void addTasks(vector<vector<string> > & parts, const int depth);
+
+  // merge the record into t, spilling t to parts if it is full
+  const Status addRecord(Table & t, const Record & rec, char* entry,
+			 vector<vector<string> > & parts);
+  const Status aggregate(HeapFileScan & input, Table & t,
+			 vector<vector<string> > & parts);
+  const Status loadTask(const Task & task);
+};
+
+#endif
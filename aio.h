@@ -0,0 +1,92 @@
+#ifndef AIO_H
+#define AIO_H
+
+#include <sys/uio.h>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "page.h"
+#include "db.h"
+
+// a read or write of a page of a file, handed to AsyncIO::submit.  it
+// belongs to AsyncIO until complete returns it
+struct IORequest
+{
+  bool		write;
+  File*		file;
+  int		pageNo;
+  Page*		page;		// read into or written from
+  int		tag;		// for the caller, e.g. a frame number
+  Status	status;		// set when the request completes
+  struct iovec	iov;		// used by AsyncIO
+};
+
+// Asynchronous page I/O with submit/complete semantics, so that a
+// single thread can have up to depth requests in flight.  Requests are
+// queued by submit and started, in one system call, by the next call
+// of start or complete.  It uses io_uring through its system calls when
+// the kernel supports it, and otherwise a pool of threads that each do
+// one pread or pwrite at a time.  The calls take turns: the caller
+// serializes them, as BufMgr does with its lock.
+
+class AsyncIO
+{
+ public:
+  // with ring false the threads are used even if io_uring is there
+  AsyncIO(const int depth, Status & status, const bool ring = true);
+
+  // waits for the requests in flight
+  ~AsyncIO();
+
+  // queue req.  returns BUFFEREXCEEDED if depth requests are in flight
+  const Status submit(IORequest* req);
+
+  // start the queued requests
+  const Status start();
+
+  // return a completed request in req, waiting for one if wait is set
+  // and some are in flight, and NULL if there is none
+  const Status complete(IORequest* & req, const bool wait = true);
+
+  const int inFlight() const { return pending; }
+  const int getDepth() const { return depth; }
+  const bool usesRing() const { return ringFd >= 0; }
+
+ private:
+  int		depth;
+  int		pending;	// submitted and not completed
+
+  // io_uring
+  int		ringFd;
+  void*		sqRing;
+  void*		cqRing;
+  size_t	sqSize;
+  size_t	cqSize;
+  struct io_uring_sqe* sqes;
+  size_t	sqesSize;
+  unsigned*	sqHead;
+  unsigned*	sqTail;
+  unsigned*	sqMask;
+  unsigned*	sqArray;
+  unsigned*	cqHead;
+  unsigned*	cqTail;
+  unsigned*	cqMask;
+  struct io_uring_cqe* cqes;
+  unsigned	toSubmit;	// queued in the ring, not yet started
+
+  // threads
+  vector<thread> workers;
+  mutex		lock;
+  condition_variable queued;	// todo is not empty, or stopping
+  condition_variable done;	// finished is not empty
+  deque<IORequest*> todo;
+  deque<IORequest*> finished;
+  bool		stopping;
+
+  const bool setupRing();
+  void work();
+};
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include "heapfile.h"
+
+// A B+-tree index maps the keys of an attribute of a heap file to the
+// RIDs of its records.  The index is a file of its own, read and
+// written a page at a time through the buffer manager.
+//
+// Entries are ordered on (key, rid), so every entry is unique even if
+// keys repeat, and the entry of a given record can be found and
+// deleted directly.  A leaf holds entries, an inner node child pointers
+// with the first entry of each child but the first as separator.  The
+// leaves are linked left to right.  Deleting an entry never merges
+// pages; an emptied leaf stays in the chain until the index is rebuilt.
+//
+// A leaf entry can carry a fixed number of included bytes after the
+// rid, copies of other attributes of the record, so that a query that
+// needs only those and the key is answered without the heap file.
+//
+// An empty index can be bulk loaded from entries in key order.  The
+// tree is then built bottom up in a single pass: the rightmost node of
+// every level stays pinned, a full node is left for a new one, and the
+// new node is entered in the level above, so each page is allocated
+// after the one before it and written once.
+
+// header page of an index file
+struct BTreeHdrPage
+{
+  int		rootPage;	// pageNo of the root
+  int		height;		// number of levels, 1 if the root is a leaf
+  int		keyLen;		// length of a key
+  int		keyType;	// Datatype of a key
+  int		entryCnt;	// number of entries
+  int		inclLen;	// included bytes of a leaf entry
+};
+
+// layout of an index page: the entries follow the header.  an inner
+// entry is key, rid and child pageNo, a leaf entry key, rid and the
+// included bytes
+struct BTreeNode
+{
+  int		level;		// 0 for a leaf
+  int		keyCnt;		// number of entries
+  int		nextPage;	// leaf: pageNo of right neighbour, or -1
+  int		firstChild;	// inner node: child left of all entries
+};
+
+// create an empty index of keys of keyLen bytes of type keyType, with
+// inclLen included bytes in every leaf entry
+const Status createBTreeIndex(const string & indexName, const int keyLen,
+                              const Datatype keyType, const int inclLen = 0);
+const Status destroyBTreeIndex(const string & indexName);
+
+class BTreeIndex {
+public:
+  // open the index file indexName
+  BTreeIndex(const string & indexName, Status & status);
+  ~BTreeIndex();
+
+  // add the entry (key, rid) with the included bytes incl, zeroes if
+  // NULL.  NONUNIQUEENTRY if it is there already
+  const Status insertEntry(const char* key, const RID & rid,
+                           const char* incl = NULL);
+
+  // remove the entry (key, rid).  RECNOTFOUND if it is not there
+  const Status deleteEntry(const char* key, const RID & rid);
+
+  // fill the index, which has to be empty, with the entries that next
+  // returns until it returns FILEEOF.  they come in key order, those
+  // with equal keys in any order.  leaves and inner nodes are filled
+  // to fillFactor, in (0, 1], of their capacity
+  const Status bulkLoad(const function<const Status(const char* & key,
+                                                    RID & rid,
+                                                    const char* & incl)> & next,
+                        const double fillFactor);
+
+  // scan the entries whose key lies between lowVal and highVal, in key
+  // order.  lowOp is GT or GTE, highOp LT or LTE, and a NULL value
+  // leaves that end open.  the bounds are copied
+  const Status startScan(const char* lowVal, const Operator lowOp,
+                         const char* highVal, const Operator highOp);
+
+  // return the rid of the next entry of the scan, or FILEEOF.  entries
+  // inserted or deleted during the scan are seen if they come after
+  // the last entry returned
+  const Status scanNext(RID & outRid);
+
+  // the key and included bytes of the entry last returned by scanNext
+  const char* getKey() const { return lastKey.data(); }
+  const char* getIncluded() const { return lastIncl.data(); }
+
+  const Status markScan();	// save the position of the scan
+  const Status resetScan();	// go back to the saved position
+  const Status endScan();
+
+  const int getEntryCnt() const { return hdr->entryCnt; }
+  const int getHeight() const { return hdr->height; }
+  const int getInclLen() const { return hdr->inclLen; }
+
+private:
+  File*		file;
+  BTreeHdrPage* hdr;		// pinned header page
+  int		hdrPageNo;
+  bool		hdrDirty;
+  int		leafCap;	// entries that fit in a leaf
+  int		innerCap;	// entries that fit in an inner node
+
+  // the scan.  it is positioned after the last entry returned, so it
+  // finds its place again however the leaf has changed since
+  bool		scanning;
+  vector<char>	lowKey, highKey; // bounds, empty if open
+  Operator	lowOp, highOp;
+  bool		started;	// an entry has been returned
+  vector<char>	lastKey;	// last entry returned
+  RID		lastRid;
+  vector<char>	lastIncl;
+  int		leafNo;		// leaf of the last entry, pinned, or -1
+  BTreeNode*	leaf;
+  bool		markedStarted;	// position saved by markScan
+  vector<char>	markedKey;
+  RID		markedRid;
+
+  const int entrySize(const BTreeNode* node) const;
+  char* entry(BTreeNode* node, const int i) const;
+  const RID entryRid(BTreeNode* node, const int i) const;
+  const int entryChild(BTreeNode* node, const int i) const;
+  const int compareKey(const char* a, const char* b) const;
+  const int compareEntry(BTreeNode* node, const int i,
+                         const char* key, const RID & rid) const;
+  // number of entries of node that are <= (key, rid)
+  const int search(BTreeNode* node, const char* key, const RID & rid) const;
+
+  // insert below pageNo.  if the page is split, split is set and the
+  // separator entry and new page are returned in sep and newPageNo
+  const Status insert(const int pageNo, const char* key, const RID & rid,
+                      const char* incl, bool & split, vector<char> & sep,
+                      int & newPageNo);
+  void copyKey(const char* val, vector<char> & key) const;
+  const Status findLeaf(const char* key, const RID & rid, int & pageNo,
+                        BTreeNode* & node);
+  const Status unpinLeaf();
+
+  // the rightmost node of a level of a bulk load
+  struct BulkNode {
+    int		pageNo;
+    BTreeNode*	node;
+  };
+
+  // add the entry ent to the level of a bulk load, with child for an
+  // inner level.  fill is the number of entries a node is given
+  const Status bulkAdd(vector<BulkNode> & levels, const int level,
+                       const char* ent, const int child, const int fill[2]);
+};
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef BUF_H
 #define BUF_H
 
+#include <mutex>
 #include "db.h"
+#include "aio.h"
 // define if debug output wanted
 //#define DEBUGBUF
 
@@ -42,6 +44,13 @@ public:
 };
 
 
+// reads and writes a buffer pool keeps in flight, at most
+const int IODEPTH = 32;
+
+// dirty frames ahead of the clock hand that allocBuf starts writing
+const int WRITEBEHIND = 4;
+
+
 class BufMgr;  //forward declaration of BufMgr class 
 
 // class for maintaining information about buffer pool frames
@@ -55,6 +64,8 @@ private:
   bool 	dirty;	  // true if dirty;  false otherwise
   bool 	valid;   // true if page is valid
   bool  refbit;	 // has this buffer frame been reference recently
+  bool	ioPending; // a read or write of the frame is in flight
+  bool	prefetched; // read by prefetch and not asked for since
 
   void Clear() {  // initialize buffer frame for a new user
     	pinCnt = 0;
@@ -62,6 +73,8 @@ private:
 	pageNo = -1;
     	dirty = false;
 	valid = false;
+	ioPending = false;
+	prefetched = false;
   };
 
   void Set(File* filePtr, int pageNum) { 
@@ -71,6 +84,8 @@ private:
       dirty = false;
       valid = true;
       refbit = true;
+      ioPending = false;
+      prefetched = false;
   }
 
   BufDesc() {
@@ -105,8 +120,33 @@ private:
   BufHashTbl*    hashTable;  	// hash table mapping (File, page) to frame
   BufDesc*	 bufTable;  	// vector of status info, 1 per page
   BufStats	 bufStats;	// buffer pool statistics
-
-  const Status allocBuf(int & frame);   // allocate a free frame.  
+  mutex		 lock;		// the public calls take turns, so that
+				// several threads can share the pool
+  AsyncIO*	 io;		// readahead and writeback, or NULL
+  vector<IORequest> requests;	// the request of each frame
+  vector<pair<const File*, int> > failedReads; // pages whose read in
+				// the background failed, at most IODEPTH;
+				// requestPage reads them the slow way so
+				// that the error reaches the caller
+
+  // allocate a free frame.  frames with I/O in flight are not taken;
+  // if they are all that is left it waits for them, unless wait is false
+  const Status allocBuf(int & frame, const bool wait = true);
+  // start reading page pageNo of file into an unpinned frame.  returns
+  // BUFFEREXCEEDED if no frame is free without waiting
+  const Status startRead(File* file, const int pageNo);
+  // start writing the dirty frame, and clean it
+  const Status startWrite(const int frame);
+  // start writing dirty frames that the clock hand reaches next
+  const Status writeBehind();
+  // finish a completed request, waiting for one if wait is set.  frame
+  // is set to its frame, or -1 if none completed
+  const Status reap(const bool wait, int & frame);
+  // wait for the I/O of the frame holding page pageNo of file, then
+  // look the page up in the hash table
+  const Status lookupDone(const File* file, const int pageNo, int & frame);
+  // wait for all I/O of file, or of every file if it is NULL
+  const Status drain(const File* file);
   const void releaseBuf(int frame); // return unused frame to end of list
   void advanceClock()
   {
@@ -117,10 +157,40 @@ private:
 public:
   Page*	         bufPool;   // actual buffer pool
 
-  BufMgr(const int bufs);
+  // with ring false the I/O goes to threads even if io_uring is there
+  BufMgr(const int bufs, const bool ring = true);
   ~BufMgr();
 
   const Status readPage(File* file, const int PageNo, Page*& page);
+
+  // start reading the n pages pageNos[] of file into the pool without
+  // pinning them, so that they are there when readPage asks for them.
+  // pages that are in the pool, and those beyond IODEPTH reads in
+  // flight or that would take a pinned frame, are skipped: it is only
+  // a hint.  a prefetched page counts as a disk read once it is read
+  const Status prefetch(File* file, const int pageNos[], const int n);
+
+  // readPage without waiting for the disk: if the page is in the pool
+  // it is pinned and ready is set.  otherwise, if it can be read
+  // asynchronously, its read is started, or is already in flight, and
+  // ready is cleared; the caller then waits for the read (see
+  // pagePending and waitIO) and asks again.  if it cannot, or if the
+  // read in the background failed, the page is read as by readPage,
+  // which returns the error, and ready is set
+  const Status requestPage(File* file, const int PageNo, Page*& page,
+                           bool & ready);
+
+  // true if a read or write of the page is in flight
+  const bool pagePending(const File* file, const int PageNo);
+
+  // wait until one of the reads and writes in flight completes, if any
+  const Status waitIO();
+
+  // true if the I/O goes through io_uring rather than threads
+  const bool usesRing() const
+  {
+	return io != NULL && io->usesRing();
+  }
   const Status unPinPage(File* file, const int PageNo, const bool dirty);
   const Status allocPage(File* file, int& PageNo, Page*& page); 
                         // allocates a new, empty page 
@@ -128,6 +198,11 @@ public:
   const Status disposePage(File* file, const int PageNo); // dispose of page in file
   void  printSelf();
 
+  const int getNumBufs() const // number of frames in the buffer pool
+  {
+	return numBufs;
+  }
+
   const BufStats & getBufStats() const // get buffer pool usage
   {
 	return bufStats;
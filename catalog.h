@@ -0,0 +1,115 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include "heapfile.h"
+
+// the catalog describes the records of a relation: for each relation
+// the relcat file holds a RelDesc, and for each of its attributes the
+// attrcat file holds an AttrDesc.  both are ordinary heap files of
+// fixed-length records
+
+#define RELCATNAME   "relcat"		// name of relation catalog
+#define ATTRCATNAME  "attrcat"		// name of attribute catalog
+
+const int MAXSTRINGLEN = 255;		// max. length of a string attribute
+
+// schema of relation catalog:
+//   relation name : char(MAXNAMESIZE)
+//   attribute count : int
+
+typedef struct {
+  char relName[MAXNAMESIZE];	// relation name
+  int attrCnt;			// number of attributes
+} RelDesc;
+
+// schema of attribute catalog:
+//   relation name : char(MAXNAMESIZE)
+//   attribute name : char(MAXNAMESIZE)
+//   attribute number : int
+//   attribute offset : int
+//   attribute type : int (a Datatype)
+//   attribute length : int
+
+typedef struct {
+  char relName[MAXNAMESIZE];	// relation name
+  char attrName[MAXNAMESIZE];	// attribute name
+  int attrNo;			// position of the attribute in the relation
+  int attrOffset;		// attribute offset in the record
+  int attrType;			// attribute type
+  int attrLen;			// attribute length
+} AttrDesc;
+
+// attribute of a relation to be created
+typedef struct {
+  char attrName[MAXNAMESIZE];	// attribute name
+  int attrType;			// INTEGER, FLOAT, or STRING
+  int attrLen;			// length of attribute in bytes
+} attrInfo;
+
+
+class RelCatalog : public HeapFile {
+ public:
+  // open relation catalog
+  RelCatalog(Status &status);
+
+  // get relation descriptor for a relation
+  const Status getInfo(const string & relation, RelDesc& record);
+
+  // add information to catalog
+  const Status addInfo(RelDesc & record);
+
+  // remove tuple from catalog
+  const Status removeInfo(const string & relation);
+
+  // create a new relation with attrCnt attributes.  the attributes
+  // are laid out in the order given, with INTEGER and FLOAT attributes
+  // aligned, and the file is given the page format that suits them
+  const Status createRel(const string & relation,
+			 const int attrCnt,
+			 const attrInfo attrList[]);
+
+  // destroy a relation and its catalog entries
+  const Status destroyRel(const string & relation);
+
+  // close the catalog
+  ~RelCatalog();
+};
+
+
+class AttrCatalog : public HeapFile {
+ public:
+  // open attribute catalog
+  AttrCatalog(Status &status);
+
+  // get attribute catalog tuple
+  const Status getInfo(const string & relation,
+		       const string & attrName,
+		       AttrDesc &record);
+
+  // add information to catalog
+  const Status addInfo(AttrDesc & record);
+
+  // remove tuple from catalog
+  const Status removeInfo(const string & relation, const string & attrName);
+
+  // get all attributes of a relation, in attribute number order.
+  // attrs is allocated with new [] and is to be deleted by the caller
+  const Status getRelInfo(const string & relation,
+			  int &attrCnt,
+			  AttrDesc *&attrs);
+
+  // close the catalog
+  ~AttrCatalog();
+};
+
+// create the (empty) catalog files of a new database
+const Status createCatalog();
+
+// destroy the catalog files
+const Status destroyCatalog();
+
+// the catalogs of the open database, NULL if there are none
+extern RelCatalog  *relCat;
+extern AttrCatalog *attrCat;
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef CORO_H
+#define CORO_H
+
+#include <coroutine>
+#include <deque>
+#include <vector>
+#include "page.h"
+#include "db.h"
+
+class TaskScheduler;
+
+// A coroutine returning a Status, for code that waits for pages to be
+// read without blocking its thread, such as HeapFileScan::scanNextAsync
+// and HeapFile::getRecordAsync.  A task starts suspended.  Another task
+// runs it with co_await, which returns its status, and a TaskScheduler
+// runs the outermost ones.  A task that needs a page that is being read
+// co_awaits a PageWait and is suspended until the read completes, while
+// the scheduler runs the others, so that one thread keeps many reads in
+// flight.
+
+class IOTask {
+ public:
+  struct promise_type;
+  typedef coroutine_handle<promise_type> Handle;
+
+  // resumes the task that awaited the finished one, if any
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    coroutine_handle<> await_suspend(Handle h) noexcept;
+    void await_resume() noexcept {}
+  };
+
+  struct promise_type {
+    Status		status;
+    coroutine_handle<>	caller;		// task awaiting this one
+    TaskScheduler*	sched;		// runs the outermost task
+
+    promise_type() : status(OK), sched(NULL) {}
+    IOTask get_return_object() { return IOTask(Handle::from_promise(*this)); }
+    suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void return_value(const Status s) { status = s; }
+    void unhandled_exception() { terminate(); }
+  };
+
+  IOTask(IOTask && other) : h(other.h) { other.h = NULL; }
+  IOTask(const IOTask &) = delete;
+  ~IOTask() { if (h) h.destroy(); }
+
+  // co_await of a task runs it in place of the awaiting task
+  bool await_ready() { return false; }
+  coroutine_handle<> await_suspend(Handle caller);
+  const Status await_resume() { return h.promise().status; }
+
+ private:
+  friend class TaskScheduler;
+  explicit IOTask(Handle h_) : h(h_) {}
+  Handle	h;
+};
+
+// co_await PageWait(file, pageNo) suspends a task until no read or
+// write of the page is in flight, and returns at once if none is
+struct PageWait {
+  File*	file;
+  int	pageNo;
+
+  PageWait(File* file_, const int pageNo_) : file(file_), pageNo(pageNo_) {}
+  bool await_ready();
+  void await_suspend(IOTask::Handle h);
+  void await_resume() {}
+};
+
+// Runs tasks on the calling thread.  run() resumes every task that is
+// ready and, once all are waiting for pages, waits for the next read
+// or write of BufMgr to complete and wakes the tasks whose pages are
+// in.  the tasks share the buffer pool, so a record a task gets from a
+// HeapFile it shares with others is only valid until it next suspends.
+
+class TaskScheduler {
+ public:
+  TaskScheduler() : waitCnt(0) {}
+
+  // run task, from the next call of run.  the scheduler takes it over
+  void spawn(IOTask && task);
+
+  // run the tasks until they are all done.  returns the first status
+  // other than OK that a task returned, or an error of BufMgr::waitIO
+  const Status run();
+
+  // the number of times a task was suspended waiting for a page
+  const int getWaitCnt() const { return waitCnt; }
+
+ private:
+  friend struct PageWait;
+
+  // a task waiting for a page
+  struct Waiter {
+    File*		file;
+    int			pageNo;
+    coroutine_handle<>	h;
+  };
+
+  vector<IOTask>	tasks;
+  deque<coroutine_handle<> > ready;
+  vector<Waiter>	waiting;
+  int			waitCnt;
+
+  void wait(File* file, const int pageNo, coroutine_handle<> h);
+};
+
+#endif
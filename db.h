@@ -5,6 +5,7 @@
 #include <functional>
 #include "error.h"
 #include <string.h>
+#include <mutex>
 using namespace std;
 
 // define if debug output wanted
@@ -19,6 +20,7 @@ class DB;
 class File {
   friend class DB;
   friend class OpenFileHashTbl;
+  friend class AsyncIO;
 
  public:
 
@@ -111,6 +113,8 @@ class DB {
 
  private:
   OpenFileHashTbl   openFiles;    // list of open files
+  mutex		    lock;	  // serializes the calls above, so that
+				  // several threads can share the DB
 };
 
 
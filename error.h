@@ -22,7 +22,7 @@ enum Status {
 // BufMgr and HashTable errors
 
        HASHTBLERROR, HASHNOTFOUND, BUFFEREXCEEDED, PAGENOTPINNED,
-       BADBUFFER, PAGEPINNED,
+       BADBUFFER, PAGEPINNED, PAGEPENDING,
 
 // Page errors
 	
@@ -51,7 +51,8 @@ enum Status {
 
 // Query errors
 
-       ATTRTYPEMISMATCH, TMP_RES_EXISTS,
+       ATTRTYPEMISMATCH, TMP_RES_EXISTS, BADJOINPARM, NOTSORTED,
+       BADAGGPARM,
 
 // do not touch filler -- add codes before it
 
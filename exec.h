@@ -0,0 +1,265 @@
+#ifndef EXEC_H
+#define EXEC_H
+
+#include <functional>
+#include "heapfile.h"
+#include "agg.h"
+
+class HashJoin;
+
+// bytes of records a batch holds
+const int BATCHBYTES = 8 * PAGESIZE;
+
+// A batch of records passed from one operator of a query plan to the
+// next.  The records are copied into the batch, back to back and not
+// aligned, and stay there until it is cleared.  A batch holds up to
+// BATCHBYTES bytes of records, but always takes one record, however
+// large.
+
+class Batch {
+ public:
+  Batch();
+
+  void clear();
+
+  // room for a record of length bytes at the end of the batch, or NULL
+  // if the batch is full
+  char* append(const int length);
+
+  const int size() const { return lengths.size(); }
+  const Record get(const int i) const;
+
+  // keep only the records i for which keep[i] is set
+  void select(const vector<bool> & keep);
+
+ private:
+  vector<char>	data;
+  int		used;		// bytes of data[] taken
+  vector<int>	offsets;	// of record i in data[]
+  vector<int>	lengths;
+};
+
+// An operator of a query plan (Volcano style).  open() prepares it,
+// next() clears a batch and fills it with the next records it
+// produces, and close() releases what it holds.  next() returns FILEEOF
+// once no records are left; a batch it returns with OK is never empty.
+// Operators are chained by taking others as their inputs, which they
+// then own: they open, close and delete them.  The records flow
+// through the plan a batch at a time, and only the operators that need
+// all their input at once (the build side of a join, an aggregation)
+// hold on to it, spilling to temporary heap files when it does not fit.
+
+class Iterator {
+ public:
+  virtual ~Iterator() {}
+  virtual const Status open() = 0;
+  virtual const Status next(Batch & batch) = 0;
+  virtual const Status close() = 0;
+};
+
+// a comparison of the attribute [offset, offset+length) of a record,
+// of type type, with the value at value: attribute op value
+struct Predicate
+{
+  int		offset;
+  int		length;
+  Datatype	type;
+  Operator	op;
+  const char*	value;
+};
+
+// the records of the heap file fileName that satisfy pred, unless it
+// is NULL.  the filter goes to HeapFileScan, so that an index answers
+// it if it can.  with projections the records are the projected
+// attributes, packed by scanProject.  with a cursor only the pages it
+// hands out are scanned (see HeapFileScan::shareScan)
+
+class ScanOp : public Iterator {
+ public:
+  ScanOp(const string & fileName,
+	 const Predicate* pred = NULL,
+	 const Projection proj[] = NULL,
+	 const int projCnt = 0,
+	 PageCursor* cursor = NULL);
+  ~ScanOp();
+
+  const Status open();
+  const Status next(Batch & batch);
+  const Status close();
+
+ private:
+  string	fileName;
+  bool		filtered;
+  Predicate	pred;
+  vector<Projection> proj;
+  int		width;		// of a projected record
+  PageCursor*	cursor;
+
+  HeapFileScan*	scan;
+  vector<char>	buf;		// of scanProject
+  bool		pending;	// current record of the scan is not taken yet
+};
+
+// the records of input that satisfy pred.  they are filtered in their
+// batch, without being copied
+
+class FilterOp : public Iterator {
+ public:
+  FilterOp(Iterator* input, const Predicate & pred);
+  ~FilterOp();
+
+  const Status open();
+  const Status next(Batch & batch);
+  const Status close();
+
+ private:
+  Iterator*	input;
+  Predicate	pred;
+  vector<bool>	keep;
+};
+
+// the projCnt projections proj[] of the records of input, packed back
+// to back.  bytes beyond the end of a short record are zeroed
+
+class ProjectOp : public Iterator {
+ public:
+  ProjectOp(Iterator* input, const Projection proj[], const int projCnt);
+  ~ProjectOp();
+
+  const Status open();
+  const Status next(Batch & batch);
+  const Status close();
+
+ private:
+  Iterator*	input;
+  vector<Projection> proj;
+  int		width;
+
+  Batch		in;		// current batch of input
+  int		inNext;		// next record of in to project
+};
+
+// Equi-join of the records of left and right, each pair the left
+// record followed by the right one, as HashJoin.  open() loads right
+// into a hash table of up to maxPages*PAGESIZE bytes, and left is then
+// streamed past it.  If right does not fit, both inputs are written to
+// temporary heap files and joined by a HashJoin of maxPages pages,
+// which partitions them.
+
+class JoinOp : public Iterator {
+ public:
+  JoinOp(Iterator* left,
+	 const int leftOffset,
+	 Iterator* right,
+	 const int rightOffset,
+	 const int length,
+	 const Datatype type,
+	 const int maxPages);
+  ~JoinOp();
+
+  const Status open();
+  const Status next(Batch & batch);
+  const Status close();
+
+  // true if the last open() spilled the inputs
+  const bool spilled() const { return didSpill; }
+
+ private:
+  // a record of right in the table
+  struct Entry {
+    int		next;		// next entry of the bucket, or -1
+    unsigned	hash;
+    int		offset;		// in records
+    int		length;
+  };
+
+  Iterator*	input[2];	// left and right
+  int		offset[2];	// join attribute of left and right
+  int		length;
+  Datatype	type;
+  int		maxPages;
+
+  vector<char>	records;	// of right
+  vector<Entry>	entries;
+  vector<int>	heads;		// first entry of each bucket
+
+  Batch		in;		// current batch of left
+  int		inNext;		// record of in being probed
+  int		match;		// next entry of its bucket to look at
+
+  int		planNo;		// names the spill files
+  bool		spillMade;	// spill files to destroy
+  bool		didSpill;
+  HashJoin*	join;		// join of the spill files, if right did not fit
+  HeapFileScan*	scan[2];
+  Record	pair[2];	// last pair of join
+  bool		pending;	// pair is not taken yet
+
+  const char* key(const int s, const Record & rec) const;
+  const bool sameKey(const char* a, const char* b) const;
+  // write the table, the records of batch from from on, the rest of
+  // right and left to spill files and start a HashJoin of them
+  const Status spill(Batch & batch, const int from);
+  // add the pair l, r to batch, false if it is full
+  const bool append(Batch & batch, const Record & l, const Record & r) const;
+};
+
+// GROUP BY of the records of input, as HashAggregate, which open()
+// hands all of them.  the records are those of HashAggregate::next
+
+class AggOp : public Iterator {
+ public:
+  AggOp(Iterator* input,
+	const AggAttr groupBy[],
+	const int groupCnt,
+	const AggSpec aggs[],
+	const int aggCnt,
+	const int maxPages);
+  ~AggOp();
+
+  const Status open();
+  const Status next(Batch & batch);
+  const Status close();
+
+  // where aggregate i is in a record, once open
+  const int getAggOffset(const int i) const { return agg->getAggOffset(i); }
+
+ private:
+  Iterator*	input;
+  vector<AggAttr> groupBy;
+  vector<AggSpec> aggs;
+  int		maxPages;
+
+  HashAggregate* agg;
+  Record	rec;		// last group of agg
+  bool		pending;	// rec is not taken yet
+};
+
+// Sinks: run plan, opening it, handing each batch it produces to
+// consume until consume returns a status other than OK, and closing it
+const Status runPlan(Iterator & plan,
+		     const function<const Status(const Batch &)> & consume);
+
+// run plan, inserting the records it produces into a new heap file
+const Status writePlan(Iterator & plan, const string & fileName);
+
+// pages of a morsel
+const int MORSELPAGES = 16;
+
+// Morsel-driven parallel execution: threads workers scan the heap file
+// fileName together, taking its pages a morsel of morselPages pages at
+// a time from a MorselQueue, and stealing morsels once their own are
+// done.  Every worker runs the whole plan that makePlan builds around a
+// ScanOp on the PageCursor it is given, and hands the batches to
+// consume along with its number, so consume is called from several
+// threads at once.  The first status other than OK stops the workers
+// and is returned.  steals, unless NULL, is set to the number of
+// morsels that were stolen
+const Status runMorsels(const string & fileName, const int threads,
+			const function<Iterator*(PageCursor* cursor)> & makePlan,
+			const function<const Status(const int worker,
+						    const Batch & batch)> & consume,
+			const int morselPages = MORSELPAGES,
+			int* steals = NULL);
+
+#endif
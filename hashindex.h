@@ -0,0 +1,111 @@
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+#include "heapfile.h"
+
+// An extendible hash index maps the keys of an attribute of a heap
+// file to the RIDs of its records, for equality lookups only.
+//
+// A directory of 2^depth entries, kept on pages listed in the header,
+// maps the low depth bits of the hash of a key to the bucket page that
+// holds its entries.  A full bucket of local depth d is split on bit d
+// of the hash, and the directory is doubled when d reaches its depth;
+// the index grows a bucket at a time and is never rebuilt.  A probe
+// reads the directory page and the bucket page.
+//
+// Entries whose keys all hash alike cannot be split apart; a bucket of
+// them gets a chain of overflow pages instead.  Deleting an entry never
+// merges buckets.
+
+// header page of an index file.  the pageNos of the directory pages
+// follow it
+struct HashHdrPage
+{
+  int		depth;		// global depth: 2^depth directory entries
+  int		keyLen;		// length of a key
+  int		keyType;	// Datatype of a key
+  int		entryCnt;	// number of entries
+  int		bucketCnt;	// number of buckets
+  int		dirPageCnt;	// number of directory pages
+};
+
+// layout of a bucket page: the entries, each key and rid, follow the
+// header
+struct HashBucket
+{
+  int		depth;		// local depth: the low depth bits of the
+				// hashes of its keys are the same
+  int		keyCnt;		// number of entries on this page
+  int		nextPage;	// overflow page, or -1
+};
+
+// hash of the attribute value key of length bytes of type type, such
+// that values that compare equal hash alike.  seed picks one of a
+// family of hash functions
+const unsigned hashKey(const char* key, const int length, const Datatype type,
+                       const unsigned seed = 0);
+
+// create an empty index of keys of keyLen bytes of type keyType
+const Status createHashIndex(const string & indexName, const int keyLen,
+                             const Datatype keyType);
+const Status destroyHashIndex(const string & indexName);
+
+class HashIndex {
+public:
+  // open the index file indexName
+  HashIndex(const string & indexName, Status & status);
+  ~HashIndex();
+
+  // add the entry (key, rid).  NONUNIQUEENTRY if it is there already,
+  // DIROVERFLOW if the bucket has to be split and the directory cannot
+  // grow any further
+  const Status insertEntry(const char* key, const RID & rid);
+
+  // remove the entry (key, rid).  RECNOTFOUND if it is not there
+  const Status deleteEntry(const char* key, const RID & rid);
+
+  // scan the entries whose key equals value.  they are all looked up
+  // here, so entries inserted or deleted during the scan are not seen
+  const Status startScan(const char* value);
+
+  // return the rid of the next entry of the scan, or FILEEOF
+  const Status scanNext(RID & outRid);
+
+  const Status markScan();	// save the position of the scan
+  const Status resetScan();	// go back to the saved position
+  const Status endScan();
+
+  const int getEntryCnt() const { return hdr->entryCnt; }
+  const int getBucketCnt() const { return hdr->bucketCnt; }
+  const int getDepth() const { return hdr->depth; }
+
+private:
+  File*		file;
+  HashHdrPage*	hdr;		// pinned header page
+  int		hdrPageNo;
+  bool		hdrDirty;
+  int		entrySize;	// key and rid
+  int		bucketCap;	// entries that fit in a bucket page
+
+  bool		scanning;
+  vector<RID>	matches;	// rids of the entries of the scan
+  int		next;		// position of the scan in matches
+  int		marked;
+
+  int* dirPages() const;
+  char* entry(HashBucket* bucket, const int i) const;
+  const RID entryRid(HashBucket* bucket, const int i) const;
+  const bool sameKey(const char* a, const char* b) const;
+  const unsigned hash(const char* key) const;
+  void copyKey(const char* val, vector<char> & key) const;
+
+  // read and write directory entry slot
+  const Status getBucket(const unsigned slot, int & pageNo);
+  const Status setBucket(const unsigned slot, const int pageNo);
+
+  // split the bucket of the keys that hash to hashVal, doubling the
+  // directory if need be
+  const Status split(const unsigned hashVal);
+};
+
+#endif
@@ -5,11 +5,15 @@
 #include <functional>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <string.h>
+#include <limits.h>
+#include <mutex>
 using namespace std;
 
 #include "page.h"
 #include "buf.h"
+#include "coro.h"
 
 extern DB db;
 
@@ -18,19 +22,96 @@ extern DB db;
 
 // Some constant definitions
 const unsigned MAXNAMESIZE = 50;
+const int MAXATTRS = 32;		// attributes of a PAX record
+const int MAXINDEXES = 8;		// indexes on a heap file
+const int MAXINCLUDES = 4;		// attributes included in an index
+const double INDEXFILL = 0.9;		// fill factor of a new B+-tree
+const int READAHEAD = 8;		// pages a scan reads ahead
 
 enum Datatype { STRING, INTEGER, FLOAT };    // attribute data types
 enum Operator { LT, LTE, EQ, GTE, GT, NE };  // scan operators
 
+enum IndexKind { BTREEINDEX, HASHINDEX };	// index structures
+
+// an attribute to be returned by a projected scan: the bytes
+// [offset, offset+length) of the record
+struct Projection
+{
+  int		offset;
+  int		length;
+};
+
+// an index on the attribute [offset, offset+length) of the records of
+// a heap file.  the leaf entries of a B+-tree also hold the bytes of
+// the included attributes, one after the other
+struct IndexDesc
+{
+  int		offset;
+  int		length;		// 0 if the descriptor is not in use
+  int		type;		// Datatype of the attribute
+  int		kind;		// IndexKind
+  int		inclCnt;	// number of included attributes
+  Projection	incl[MAXINCLUDES];
+};
+
 struct FileHdrPage
 {
   char		fileName[MAXNAMESIZE];   // name of file
   int		firstPage;	// pageNo of first data page in file
   int		lastPage;	// pageNo of last data page in file
   int		pageCnt;	// number of pages
+  int		seqPages;	// 1 while the data pages are exactly the
+				// pages firstPage .. lastPage, in chain
+				// order; 0 once an overflow page is taken
   int		recCnt;		// record count
+  int		recLen;		// length of every record in a file of
+				// FIXEDLEN or PAX pages, 0 for SLOTTED pages
+  int		attrCnt;	// number of attributes, 0 unless PAX
+  int		attrLen[MAXATTRS]; // PAX: length of every attribute
+  IndexDesc	indexes[MAXINDEXES]; // index i is the file indexName(i)
+};
+
+// create a heap file. if recLen is given the file holds records of
+// exactly recLen bytes, kept on FIXEDLEN pages.  if attribute lengths
+// are given the records are made of attrCnt attributes of attrLen[i]
+// bytes and are kept on PAX pages
+const Status createHeapFile(const string fileName);
+const Status createHeapFile(const string fileName, const int recLen);
+const Status createHeapFile(const string fileName, const int attrCnt,
+                            const int attrLen[]);
+const Status destroyHeapFile(const string fileName);
+
+// name of the file of index indexNo of heap file fileName
+const string indexName(const string & fileName, const int indexNo);
+
+// format a new data page of the file whose header is hdrPage
+void initPage(const FileHdrPage* hdrPage, Page* page, const int pageNo);
+
+
+// a record that does not fit on an empty data page is stored out of
+// line in a chain of overflow pages.  its slot on the data page holds
+// an OverflowStub instead of the record (see Page::isOverflow)
+struct OverflowStub
+{
+  int		length;		// length of the record
+  int		firstPage;	// pageNo of first overflow page
+};
+
+const unsigned OVERFLOWDATASIZE = PAGESIZE - 2*sizeof(int);
+
+struct OverflowPage
+{
+  int		nextPage;	// pageNo of next overflow page, -1 if last
+  int		length;		// number of bytes of the record in data[]
+  char		data[OVERFLOWDATASIZE];
 };
 
+// largest record that is stored on a data page
+const int MAXINPAGEREC = PAGESIZE - DPFIXED - sizeof(slot_t);
+
+class BTreeIndex;
+class HashIndex;
+
 
 // class definition of heapFile
 class HeapFile {
@@ -45,6 +126,48 @@ protected:
    bool  	curDirtyFlag;   // true if page has been updated
    RID   	curRec;         // rid of last record returned
 
+   vector<char> recBuf;		// large record materialized by getRecord
+
+   // make the data page pageNo the current page
+   const Status gotoPage(const int pageNo);
+
+   // get record rid from the current page. the attributes of a record
+   // on a PAX page are gathered in recBuf
+   const Status pageRecord(const RID & rid, Record & rec);
+
+   // read bytes [start, start+len) of the large record described by
+   // stub into buf. nread is set to the number of bytes copied
+   const Status readOverflow(const OverflowStub & stub, const int start,
+                             const int len, char* buf, int & nread);
+
+   // replace the overflow stub rec with the first len bytes of the
+   // large record, materialized in recBuf
+   const Status getOverflow(Record & rec, const int len);
+
+   // store rec in a chain of overflow pages, describing it in stub
+   const Status writeOverflow(const Record & rec, OverflowStub & stub);
+
+   // release the overflow pages of a large record
+   const Status disposeOverflow(const OverflowStub & stub);
+
+   BTreeIndex*	indexes[MAXINDEXES];	// open B+-tree indexes of the file
+   HashIndex*	hashIndexes[MAXINDEXES]; // open hash indexes
+   IndexDesc	indexDescs[MAXINDEXES];	// what they were opened as
+
+   // bring the open indexes in line with the header, which another
+   // HeapFile object on the same file may have changed
+   const Status openIndexes();
+
+   // add the entries of the record rec at rid to the indexes, or with
+   // remove set take them out
+   const Status updateIndexes(const Record & rec, const RID & rid,
+                              const bool remove);
+
+   const Status buildIndex(const int offset, const int length,
+                           const Datatype type, const IndexKind kind,
+                           const Projection incl[], const int inclCnt,
+                           const double fillFactor);
+
 public:
 
   // initialize
@@ -56,8 +179,127 @@ public:
   // return number of records in file
   const int getRecCnt() const;
 
+  // the numbers of the data pages of the file, in the order of the
+  // page chain.  every page is read to find the next one
+  const Status getPageNos(vector<int> & pageNos);
+
   // given a RID, read record from file, returning pointer and length
+  // a large record is returned in a buffer that is valid until the
+  // next call
   const Status getRecord(const RID &rid, Record & rec);
+
+  // getRecord as a coroutine: if the page of the record is not in the
+  // buffer pool the task is suspended until it has been read (see
+  // IOTask).  the overflow pages of a large record are read without
+  // suspending.  rec is valid until the task next suspends
+  IOTask getRecordAsync(const RID & rid, Record & rec);
+
+  // copy at most len bytes of the record starting at byte start into
+  // buf, setting nread to the number of bytes copied. for a large
+  // record only the overflow pages holding those bytes are read
+  const Status readRecord(const RID & rid, const int start, const int len,
+                          char* buf, int & nread);
+
+  // given an array of n RIDs, copy each record into buf and return
+  // a pointer and length for rids[i] in recs[i].  the RIDs are grouped
+  // by page so that every distinct page is pinned exactly once, and
+  // the pages are prefetched so that many reads are in flight at once.
+  // returns BADSCANPARM if n is negative or an array is NULL
+  const Status getRecords(const RID rids[], const int n, Record recs[],
+                          char* buf, const int bufLen);
+
+  // create an index of kind kind on the attribute [offset, offset+length)
+  // of type type and enter the records in the file.  from then on the
+  // index is kept up to date by InsertFileScan::insertRecord and
+  // HeapFileScan::deleteRecord, and filtered scans on the attribute
+  // go through it: all but NE scans for a B+-tree, EQ scans for a hash
+  // index.  records too short to hold the attribute are not indexed,
+  // as no filter on it matches them anyway.  a B+-tree is bulk loaded
+  // from the sorted keys, its pages filled to fillFactor, in (0, 1], so
+  // that later inserts do not split them all at once
+  const Status createIndex(const int offset, const int length,
+                           const Datatype type,
+                           const IndexKind kind = BTREEINDEX,
+                           const double fillFactor = INDEXFILL);
+
+  // create a B+-tree index as above whose leaf entries also hold the
+  // inclCnt attributes incl[], at most MAXINCLUDES of them.  a projected
+  // scan whose filter goes through the index and whose projections
+  // all lie in the key or in an included attribute is then answered
+  // from the index alone
+  const Status createIndex(const int offset, const int length,
+                           const Datatype type, const Projection incl[],
+                           const int inclCnt,
+                           const double fillFactor = INDEXFILL);
+
+  // destroy the index on the attribute
+  const Status destroyIndex(const int offset, const int length,
+                            const Datatype type);
+
+  // the B+-tree or hash index on the attribute, or NULL if there is none
+  BTreeIndex* getIndex(const int offset, const int length,
+                       const Datatype type);
+  HashIndex* getHashIndex(const int offset, const int length,
+                          const Datatype type);
+};
+
+
+// Morsels: the data pages of a file, split into runs of morselPages
+// pages in the order of the page chain, for workers threads that scan
+// the file together (see PageCursor).  Every worker owns a contiguous
+// share of the morsels and takes them front to back.  One that runs out
+// steals the last morsel of the worker with the most left, so that the
+// work evens out when the records of some pages take longer than those
+// of others.  The chain is walked once to find the pages.
+class MorselQueue
+{
+public:
+    MorselQueue(HeapFile & file, const int workers, const int morselPages,
+                Status & status);
+
+    // the next page for worker, -1 once no morsels are left
+    const int nextPage(const int worker);
+
+    const int getMorselCnt() const { return morselCnt; }
+    const int getStealCnt() const { return stealCnt; }
+
+private:
+    // the morsels [first, end) of a worker that are left, and the
+    // pages [page, pageEnd) of the one it is on.  first and end are
+    // guarded by lock, page and pageEnd belong to the worker
+    struct Share {
+        int first;
+        int end;
+        int page;
+        int pageEnd;
+    };
+
+    mutex lock;
+    vector<int> pages;		// data pages in chain order
+    int   morselPages;
+    vector<Share> shares;
+    int   morselCnt;
+    int   stealCnt;
+};
+
+// hands out the data pages of a file to the scans that share it (see
+// HeapFileScan::shareScan), each page to exactly one of them, so that
+// several threads can scan parts of the file at the same time.  the
+// pages are taken from the page chain in turn, or with a MorselQueue
+// from the morsels of worker
+class PageCursor
+{
+    friend class HeapFileScan;
+public:
+    PageCursor() : started(false), nextPageNo(-1), queue(NULL), worker(0) {}
+    PageCursor(MorselQueue* queue_, const int worker_)
+        : started(false), nextPageNo(-1), queue(queue_), worker(worker_) {}
+private:
+    mutex lock;
+    bool  started;		// true once the first page is handed out
+    int   nextPageNo;		// next page to hand out, -1 at the end
+    MorselQueue* queue;
+    int   worker;
 };
 
 
@@ -70,12 +312,38 @@ public:
     // end filtered scan
     ~HeapFileScan();
 
+    // a filter on an attribute that has a B+-tree index, with any
+    // operator but NE, is answered by the index; the records then come
+    // in attribute order rather than in file order.  an EQ filter is
+    // answered by a hash index on the attribute if there is one
     const Status startScan(const int offset, 
                            const int length,  
                            const Datatype type, 
                            const char* filter, 
                            const Operator op);
 
+    // start a scan filtering on the attribute attrName, whose offset,
+    // length and type are looked up in the catalog
+    const Status startScan(const string & attrName,
+                           const char* filter,
+                           const Operator op);
+
+    // a second filter on top of that of startScan, on the attribute
+    // [offset, offset+length) of type type, with the comparison value
+    // at value.  the value is read anew for every record, so that the
+    // caller can tighten the bound as the scan goes, as TopK does.  a
+    // NULL value drops the bound
+    const Status setBound(const int offset,
+                          const int length,
+                          const Datatype type,
+                          const char* value,
+                          const Operator op);
+
+    // scan only the pages handed out by cursor.  to be called before
+    // the first scanNext; markScan and resetScan are not supported on
+    // a shared scan
+    const Status shareScan(PageCursor* cursor);
+
     const Status endScan(); // terminate the scan
     const Status markScan(); // save current position of scan
     const Status resetScan(); // reset scan to last marked location
@@ -83,9 +351,46 @@ public:
     // return RID of next record that satisfies the scan 
     const Status scanNext(RID& outRid);
 
+    // scanNext as a coroutine, suspended whenever the scan moves to a
+    // data page that is not in the buffer pool until it has been read
+    // (see IOTask).  the pages of an index and of a shared scan are
+    // read without suspending
+    IOTask scanNextAsync(RID & outRid);
+
     // read current record, returning pointer and length
     const Status getRecord(Record & rec);
 
+    // pin the current page of the scan once more and return it, so
+    // that a record getRecord returned from the page stays valid after
+    // the scan has moved on, until unpinPage(pageNo).  records of PAX
+    // pages and large records are gathered in a buffer of the scan
+    // instead, which the next call overwrites
+    const Status pinPage(Page* & page, int & pageNo);
+    const Status unpinPage(const int pageNo);
+
+    // page at a time scan of an unfiltered scan, instead of scanNext:
+    // move to the next data page, or the first if the scan has not
+    // returned any record of the current page yet, and return it.  the
+    // page stays pinned until the scan moves on.  returns FILEEOF once
+    // no pages are left, and BADSCANPARM if the scan has a filter or a
+    // bound
+    const Status scanPage(Page* & page);
+
+    // true if the last call of scanProject was answered from the
+    // leaf entries of a B+-tree alone, without reading heap pages.
+    // the current record of the scan is then left where it was
+    const bool servedIndexOnly() const { return indexOnly; }
+
+    // projected scan: for each of the next records that satisfy the
+    // scan, pack the projCnt projections proj[] back to back into buf,
+    // as many records as fit in its bufLen bytes.  recCnt is set to the
+    // number of records packed, and if rids is not NULL their RIDs are
+    // stored in it.  bytes beyond the end of a short record are zeroed.
+    // returns FILEEOF once no records are left
+    const Status scanProject(const Projection proj[], const int projCnt,
+                             char* buf, const int bufLen, int & recCnt,
+                             RID rids[] = NULL);
+
     // delete current record 
     const Status deleteRecord();
 
@@ -99,6 +404,12 @@ private:
     const char* filter;      // comparison value of filter
     Operator op;             // comparison operator of filter
 
+    int   boundOffset;       // the bound of setBound, if bound is not NULL
+    int   boundLength;
+    Datatype boundType;
+    const char* bound;
+    Operator boundOp;
+
      // The following variables are used to preserve the state
     // of the scan when the method markScan() is invoked.
     // A subsequent invocation of resetScan() will cause the
@@ -106,7 +417,32 @@ private:
     int   markedPageNo;	// page number of pinned page
     RID   markedRec;         // rid of last record returned
 
+    BTreeIndex* index;       // index that answers the filter, or NULL
+    HashIndex* hashIndex;
+    bool  indexOnly;         // last scanProject used index entries only
+
+    PageCursor* cursor;      // shared scan: the pages to scan
+    bool  claimed;           // shared scan: curPage was handed out to us
+
+    bool  async;             // scanNext for scanNextAsync
+    int   pendingPageNo;     // page it returned PAGEPENDING for
+
+    // read data page pageNo for the scan.  in an asynchronous scan a
+    // page that is not in the pool is not waited for: its read is
+    // started and PAGEPENDING is returned
+    const Status readScanPage(const int pageNo, Page* & page);
+
+    // shared scan: move to the next page handed out by cursor
+    const Status claimPage();
+
+    // start reading the data pages that follow the current page
+    void readAhead();
+
     const bool matchRec(const Record & rec) const;
+    // compare the filter attribute at attr against the filter
+    const bool matchAttr(const char* attr) const;
+    // and the bound attribute at attr against the bound
+    const bool matchBound(const char* attr) const;
 };
 
 
@@ -0,0 +1,276 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+#include <functional>
+#include "heapfile.h"
+
+class SortedFile;
+
+// Equi-join of the records returned by two HeapFileScans, left and
+// right, on attributes of the same length and type at leftOffset and
+// rightOffset.  next() returns the pairs of records whose attributes
+// are equal; records too short to hold the attribute join nothing.
+//
+// The join builds a hash table of the records of the side with fewer
+// records and probes it with the records of the other.  The table is
+// kept in a workspace of maxPages*PAGESIZE bytes; its array of bucket
+// heads, one int per record, comes on top of that.
+//
+// If the build side does not fit, the join partitions it on the high
+// bits of the hash into fanOut partitions: partition 0 stays in memory
+// and the others are spilled to temporary heap files, as is partition
+// 0 as well should it still not fit (hybrid hashing).  Probe records
+// of a spilled partition are spilled in turn, and every pair of
+// partition files is then joined in the same way with a hash function
+// of its own.  A spill file pins two buffer frames, so fanOut is at
+// most (maxPages-4)/2.  Past MAXDEPTH levels of partitioning, as when
+// most records share a key, the build side is loaded a tableful at a
+// time and the probe side is scanned once for each.
+//
+// Pairs come in no particular order.
+
+class HashJoin {
+ public:
+  // join left and right.  neither scan is used once the join ends
+  HashJoin(HeapFileScan & left,
+	   const int leftOffset,
+	   HeapFileScan & right,
+	   const int rightOffset,
+	   const int length,
+	   const Datatype type,
+	   const int maxPages,
+	   Status & status);
+
+  // destroys the spill files that are left
+  ~HashJoin();
+
+  // return the next pair of joining records.  they are valid until
+  // the next call.  returns FILEEOF after the last pair
+  const Status next(Record & leftRec, Record & rightRec);
+
+  // number of pairs of spilled partitions joined, 0 if the build side
+  // fit in memory
+  const int getPartitionCnt() const { return partitionCnt; }
+
+ private:
+  // an entry of the hash table.  the record follows it, and entries
+  // are 8 byte aligned
+  struct Entry {
+    int		next;		// next entry of the bucket, or -1
+    unsigned	hash;
+    int		length;		// of the record
+    int		pad;
+  };
+
+  // a pair of spilled partitions to be joined, left and right
+  struct Task {
+    string	file[2];
+    int		depth;
+  };
+
+  int		offset[2];	// join attribute of left and right
+  int		length;
+  Datatype	type;
+  int		maxFanOut;
+
+  vector<char>	table;		// the workspace
+  int		used;		// bytes of entries in the table
+  int		entryCnt;
+  vector<int>	heads;		// first entry of each bucket
+
+  HeapFileScan*	input[2];	// left and right input of the current join
+  bool		owned;		// inputs are spill files of the join
+  string	inputFile[2];
+  int		build;		// side the table is built from
+  int		depth;		// levels of partitioning above the inputs
+  int		fanOut;		// partitions of the inputs, 0 if none
+  int		memPart;	// partition in memory, or -1
+  bool		pending;	// current build record is not loaded yet
+
+  int		joinNo;		// names the spill files of this join
+  int		fileNo;
+  vector<InsertFileScan*> writers[2];	// spill files of each partition
+  vector<string> spillFile[2];		// of each side, "" if none
+  vector<Task>	tasks;		// partition pairs waiting to be joined
+  int		partitionCnt;
+
+  Record	probeRec;	// current probe record
+  unsigned	probeHash;
+  int		match;		// next entry of its bucket to look at
+  bool		done;
+
+  // the attribute of a record of side s, or NULL if it is too short
+  const char* key(const int s, const Record & rec) const;
+  const bool sameKey(const char* a, const char* b) const;
+  const int part(const unsigned hash) const;
+  const bool spilled(const unsigned hash) const;
+  static const int entrySize(const int recLen);
+
+  const Status load();
+  const Status partition();
+  const Status spill(const int s, const int p, const Record & rec);
+  const Status closeWriters(const int s);
+  const Status startTask(const Task & task);
+  const Status endTask();
+};
+
+// Theta-join of the records returned by two HeapFileScans, outer and
+// inner: next() returns the pairs of records for which the attribute
+// of the outer record at outerOffset compares to that of the inner
+// record at innerOffset as op says.  records too short to hold the
+// attribute join nothing.
+//
+// Rather than scanning inner again for every outer record, the join
+// reads outer a block at a time and scans inner once for each block.
+// A block holds the outer records of up to maxPages-2 pages, which
+// stay pinned in the buffer pool; the other two frames are those of
+// the inner scan.  The records of PAX pages and large records are
+// copied out instead, and every PAGESIZE bytes of them take the place
+// of a page of the block.  inner is rewound with markScan and
+// resetScan, so every pass starts where inner was when the join
+// began.
+//
+// The pairs of a block come in inner order, and within that in outer
+// order.
+
+class NestedLoopJoin {
+ public:
+  NestedLoopJoin(HeapFileScan & outer,
+		 const int outerOffset,
+		 HeapFileScan & inner,
+		 const int innerOffset,
+		 const int length,
+		 const Datatype type,
+		 const Operator op,
+		 const int maxPages,
+		 Status & status);
+
+  // unpins the pages of the block
+  ~NestedLoopJoin();
+
+  // return the next pair of joining records, the outer one in
+  // outerRec.  they are valid until the next call.  returns FILEEOF
+  // after the last pair
+  const Status next(Record & outerRec, Record & innerRec);
+
+  // passes made over inner so far, one per block
+  const int getPassCnt() const { return passCnt; }
+
+  // pages read from disk by the join so far
+  const int getPagesRead() const { return pagesRead; }
+
+ private:
+  // a record of the block, on a pinned page or copied to copies
+  struct BlockRec {
+    const char*	data;
+    int		copy;		// offset in copies, or -1
+    int		length;
+  };
+
+  HeapFileScan*	outer;
+  HeapFileScan*	inner;
+  int		offset[2];	// join attribute of outer and inner
+  int		length;
+  Datatype	type;
+  Operator	op;
+  int		blockPages;	// most pages a block may take
+
+  vector<BlockRec> block;
+  vector<int>	pinned;		// pages of the block
+  vector<char>	copies;
+  bool		pending;	// current outer record is not in a block yet
+  bool		outerDone;	// outer has been read to its end
+
+  Record	innerRec;	// current inner record
+  unsigned	blockNext;	// next record of the block to look at
+  bool		done;
+
+  int		passCnt;
+  int		pagesRead;
+
+  const Status load();
+  const Status release();
+  const Status nextPair(Record & outerRec, Record & innerRec);
+};
+
+// Equi-join of two streams of records sorted on their attributes, as
+// HashJoin.  A side whose scan returns its records in attribute order
+// already, such as a scan through a B+-tree, is marked as sorted and
+// read as it is; the other side is sorted on the fly with a
+// SortedFile.  Records too short to hold the attribute join nothing.
+//
+// The join merges the two streams.  The right records of a key, its
+// duplicate group, are buffered in up to maxPages/4 pages of memory
+// and the rest of the group is spilled to a temporary heap file; every
+// left record of the key is then paired with the group, reading the
+// spill file again each time.  The other pages of maxPages are shared
+// by the sorts, which need 6 pages each.
+//
+// The pairs come in key order, and within a key in left order and then
+// in right order.
+
+class SortMergeJoin {
+ public:
+  // join left and right.  neither scan is used once the join ends
+  SortMergeJoin(HeapFileScan & left,
+		const int leftOffset,
+		const bool leftSorted,
+		HeapFileScan & right,
+		const int rightOffset,
+		const bool rightSorted,
+		const int length,
+		const Datatype type,
+		const int maxPages,
+		Status & status);
+
+  // destroys the spill file and the runs of the sorts
+  ~SortMergeJoin();
+
+  // return the next pair of joining records.  they are valid until
+  // the next call.  returns FILEEOF after the last pair, and NOTSORTED
+  // if a side marked sorted is not
+  const Status next(Record & leftRec, Record & rightRec);
+
+  // write each pair not yet returned by next to a new heap file as one
+  // record, the left record followed by the right one
+  const Status writeFile(const string & fileName);
+
+  // call emit with each pair not yet returned by next, stopping at the
+  // first status other than OK that it returns
+  const Status forEach(const function<const Status(const Record &,
+						   const Record &)> & emit);
+
+  // records of the largest duplicate group spilled to disk
+  const int getSpillCnt() const { return spillCnt; }
+
+ private:
+  int		offset[2];	// join attribute of left and right
+  int		length;
+  Datatype	type;
+
+  HeapFileScan*	scan[2];	// inputs read as they are
+  SortedFile*	sorter[2];	// or sorted first, if not NULL
+  Record	cur[2];		// current record of each side
+  bool		have[2];	// false once a side has ended
+  string	lastKey[2];	// of a side read as it is
+
+  int		groupBytes;	// most bytes of the group in memory
+  string	groupKey;
+  vector<char>	group;		// records of the group in memory
+  vector<int>	groupRecs;	// where they start in group
+  vector<int>	groupLens;
+  string	spillFile;	// rest of the group, "" if none
+  InsertFileScan* spillWriter;
+  HeapFileScan*	spillScan;
+  int		spillCnt;
+  bool		inGroup;	// pairing the current left record
+  unsigned	groupNext;	// next record of the group in memory
+
+  const char* key(const int s, const Record & rec) const;
+  const int compare(const char* a, const char* b) const;
+  const Status read(const int s);
+  const Status loadGroup();
+  const Status endGroup();
+};
+
+#endif
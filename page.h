@@ -17,45 +17,162 @@ struct Record
   int length;
 };
 
+// page size in bytes.  it is fixed at compile time for the whole
+// system (Page, File I/O and BufMgr all work in units of sizeof(Page));
+// build with e.g. make PAGESIZE=8192 to pick another one
+#ifndef MINIREL_PAGESIZE
+#define MINIREL_PAGESIZE 1024
+#endif
+
+const unsigned PAGESIZE = MINIREL_PAGESIZE;
+
+// type of the offsets and counters kept in a page.  16 bits cover
+// pages of up to 16 KB (offsets may carry SLOTOVERFLOW, see below),
+// larger pages need 32-bit slot offsets
+#if MINIREL_PAGESIZE > 16384
+typedef int pageoff_t;
+#else
+typedef short pageoff_t;
+#endif
+
 // slot structure
 struct slot_t {
-        short	offset;  
-        short	length;  // equals -1 if slot is not in use
+        pageoff_t	offset;  // for a free slot, the next free slot or -1
+        pageoff_t	length;  // equals -1 if slot is not in use
 };
 
-const unsigned PAGESIZE = 1024;
-const unsigned DPFIXED= sizeof(slot_t)+4*sizeof(short)+2*sizeof(int);
+// a slot whose offset has SLOTOVERFLOW added to it holds an overflow
+// stub: the record is too large for a page and is kept out of line,
+// the stub tells the heap file layer where to find it
+const int SLOTOVERFLOW = PAGESIZE;
+
+const unsigned DPFIXED= sizeof(slot_t)+8*sizeof(pageoff_t)+2*sizeof(int)+
+                       sizeof(unsigned long long);
 const unsigned PAGEDATASIZE = PAGESIZE-DPFIXED+sizeof(slot_t);
 // size of the data area of a page
 
+// SLOTTED pages: the slots that a bit of liveGroups stands for, so
+// that 64 bits cover the largest slot array
+const int SLOTGROUP = ((PAGESIZE - DPFIXED) / sizeof(slot_t) + 64) / 64;
+
+// page formats
+enum PageFormat {
+    SLOTTED,	// variable-length records addressed through the slot array
+    FIXEDLEN,	// fixed-length records in an array, with a presence bitmap
+    PAX		// fixed-length records stored attribute by attribute
+};
+
 // Class definition for a minirel data page.   
-// The design assumes that records are kept compacted when
-// deletions are performed. Notice, however, that the slot
-// array cannot be compacted.  Notice, this class does not keep
+// Deletions do not move any bytes: the space of a deleted record
+// is left behind as a hole (counted in fragSpace) and the holes are
+// squeezed out by compact() only when an insertion needs more
+// contiguous space than is available at freePtr. Notice that the slot
+// array cannot be compacted; instead its free slots are chained
+// together through their offset fields, starting at freeSlot, so that
+// a free slot can be found without searching. Bit g of liveGroups is
+// set if one of the slots g*SLOTGROUP .. (g+1)*SLOTGROUP-1 is in use,
+// so that the iterators jump over groups of empty slots. Notice, this class does not keep
 // the records align, relying instead on upper levels to take
 // care of non-aligned attributes
+//
+// A FIXEDLEN page holds records of recLen bytes and has no slot array.
+// data[] starts with a bitmap of the slots in use, followed (at the
+// 8-byte aligned offset freePtr) by the array of slotCnt records, so
+// slot slotNo lives at data[freePtr + slotNo*recLen]. freeSlot is the
+// lowest slot that may be free
+//
+// A PAX page holds the same kind of records, split up by attribute:
+// after the bitmap (at offset freePtr) comes a directory with one
+// slot_t per attribute giving the offset of its minipage and the
+// attribute length.  the minipage of an attribute holds that attribute
+// of all slotCnt records back to back, so a scan that looks at one
+// attribute touches only its minipage. The attribute lengths add up
+// to recLen
 
 class Page {
 private:
     char 	data[PAGESIZE - DPFIXED]; 
     slot_t 	slot[1]; // first element of slot array - grows backwards!
-    short	slotCnt; // number of slots in use;
-    short	freePtr; // offset of first free byte in data[]
-    short	freeSpace; // number of bytes free in data[]
-    short	dummy;	// for alignment purposes
+    pageoff_t	slotCnt; // number of slots in use; FIXEDLEN: capacity
+    pageoff_t	freePtr; // offset of first free byte in data[]
+			 // FIXEDLEN: offset of the record array
+    pageoff_t	freeSpace; // number of bytes free in data[], including holes
+    pageoff_t	fragSpace; // bytes in holes left behind by deleted records
+    pageoff_t	freeSlot; // slot number of first free slot, -1 if none
+    pageoff_t	recCnt;	  // number of records on the page
+    pageoff_t	format;	  // a PageFormat
+    pageoff_t	recLen;	  // FIXEDLEN: length of every record
     int		nextPage; // forwards pointer
     int		curPage;  // page number of current pointer
+    unsigned long long liveGroups; // SLOTTED: groups of slots in use
+
+    void compact(); // squeeze the holes out of data[]
+
+    // offset in data[] of the record in slot i, without SLOTOVERFLOW
+    int recOffset(const int i) const
+    {
+        int offset = slot[i].offset;
+        return offset >= SLOTOVERFLOW ? offset - SLOTOVERFLOW : offset;
+    }
+
+    // FIXEDLEN pages: the bitmap of slots in use
+    unsigned long long* bitmap() const
+    {
+        return (unsigned long long*) data;
+    }
+
+    // FIXEDLEN pages: first slot in use at or after slotNo, or -1
+    int nextFixed(const int slotNo) const;
+
+    // SLOTTED pages: the same, by slot number (see liveGroups)
+    int nextSlotted(const int slotNo) const;
+
+    // PAX pages: the minipage directory
+    slot_t* minipages() const
+    {
+        return (slot_t*) &data[freePtr];
+    }
+
+    // FIXEDLEN and PAX pages: take the lowest free slot
+    int allocFixed();
+
+    // FIXEDLEN and PAX versions of the record operations
+    const Status insertFixed(const Record & rec, RID& rid);
+    const Status insertPax(const Record & rec, RID& rid);
+    const Status deleteFixed(const RID & rid);
+    const Status getFixed(const RID & rid, Record & rec);
 
 public:
     void init(const int pageNo); // initialize a new page
+    // initialize a new FIXEDLEN page for records of recLen bytes
+    void init(const int pageNo, const int recLen);
+
+    // initialize a new PAX page for records made of attrCnt
+    // attributes of attrLen[i] bytes
+    void init(const int pageNo, const int attrCnt, const int attrLen[]);
+
+    // returns the number of records a FIXEDLEN page of records of
+    // recLen bytes holds
+    static const int fixedCapacity(const int recLen);
+    // returns the number of records a PAX page holds, see init
+    static const int paxCapacity(const int attrCnt, const int attrLen[]);
     void dumpPage() const;       // dump contents of a page
 
     const Status getNextPage(int& pageNo) const; // returns value of nextPage
     const Status setNextPage(const int pageNo); // sets value of nextPage to pageNo
-    const short getFreeSpace() const; // returns amount of free space
+    const pageoff_t getFreeSpace() const; // returns amount of free space
 
     // inserts a new record (rec) into the page, returns RID of record 
-    const Status insertRecord(const Record & rec, RID& rid);
+    // if overflow is set, rec is the overflow stub of a large record
+    const Status insertRecord(const Record & rec, RID& rid,
+                              const bool overflow = false);
+
+    // true if the slot of rid holds an overflow stub
+    const bool isOverflow(const RID & rid) const
+    {
+        return format == SLOTTED && rid.slotNo >= 0 && -rid.slotNo > slotCnt &&
+               slot[-rid.slotNo].offset >= SLOTOVERFLOW;
+    }
 
     // delete the record with the specified rid
     const Status deleteRecord(const RID & rid);
@@ -68,8 +185,34 @@ public:
     // returns ENDOFPAGE if no more records exist on the page
     const Status nextRecord (const RID & curRid, RID& nextRid) const;
 
-    // returns reference to record with RID rid
+    // returns reference to record with RID rid.  the attributes of a
+    // record on a PAX page are not contiguous, use copyRecord instead
     const Status getRecord(const RID & rid, Record & rec);
+
+    // copy the record with RID rid into buf, which holds bufLen bytes,
+    // and set length to its length. returns INSUFMEM if buf is too small
+    const Status copyRecord(const RID & rid, char* buf, const int bufLen,
+                            int & length);
+
+    // PAX pages: the bytes [offset, offset+length) of the records, which
+    // must lie within one attribute, are at column + slotNo*stride.
+    // returns BADSCANPARM if they do not or the page is not a PAX page
+    const Status getColumn(const int offset, const int length,
+                           const char* & column, int & stride) const;
+
+    // gather the bytes [offset, offset+length) of up to max of the
+    // records in slot slotNo and after it: values is set to where they
+    // lie back to back, n to their number and slotNo to the slot to go
+    // on from.  they are copied into buf, of max*length bytes, unless
+    // they lie back to back in a PAX minipage already.  records too
+    // short to hold the bytes are left out, as are large records, which
+    // are counted in skipped.  n is 0 once the page has no more records.
+    // on a PAX page the bytes must lie within one attribute
+    const Status getValues(const int offset, const int length, int & slotNo,
+                           const int max, char* buf, const char* & values,
+                           int & n, int & skipped) const;
+
+    const bool isPax() const { return format == PAX; }
 };
 
 #endif
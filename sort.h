@@ -0,0 +1,226 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <functional>
+#include <mutex>
+#include "heapfile.h"
+
+// External merge sort of the records returned by a HeapFileScan, on
+// the attribute [offset, offset+length) of the given type.
+//
+// The sort works within a budget of maxPages pages.  Run generation
+// fills a workspace of maxPages*PAGESIZE bytes with records, sorts it
+// and writes it out as a run, a temporary heap file.  The runs are then
+// merged with a loser tree, at most fanIn = (maxPages-2)/2 at a time as
+// every open run pins two buffer frames (its header and current page)
+// and the output file another two.  Merge passes are made until no
+// more than fanIn runs are left, and the last merge is done on the fly
+// as the records are asked for with next().  If the input fits in the
+// workspace no run is written at all.
+//
+// Records with equal keys are returned in input order, and records too
+// short to hold the key come first.
+//
+// The workspace is sorted with a LSD radix sort on an 8 byte prefix of
+// each key, normalized so that comparing prefixes as unsigned numbers
+// orders the keys (the bits of an INTEGER or FLOAT, the first 8 bytes
+// of a STRING).  Only records whose prefixes are equal but do not
+// decide the order, such as STRING keys longer than 8 bytes that agree
+// in their first 8, are then compared attribute by attribute.
+//
+// A heap file can also be sorted by several threads, each with a share
+// of maxPages/threads pages.  The threads take the pages of the file
+// from a shared PageCursor and make runs of their own, merge passes
+// are shared out among them, and the last merge is split by key range:
+// the keys of the first record on each run page, recorded as the runs
+// are written, give threads-1 splitters, every thread merges the
+// records of one key range into a partition, and next() returns the
+// partitions one after the other.  Equal keys are then not kept in
+// input order, and the input is always written out as runs.
+
+class SortedFile {
+ public:
+  // sort the records of input.  the scan is run to its end
+  SortedFile(HeapFileScan & input,
+	     const int offset,
+	     const int length,
+	     const Datatype type,
+	     const int maxPages,
+	     Status & status);
+
+  // sort all records of the heap file fileName with threads threads
+  SortedFile(const string & fileName,
+	     const int offset,
+	     const int length,
+	     const Datatype type,
+	     const int maxPages,
+	     const int threads,
+	     Status & status);
+
+  // destroys the runs that are left
+  ~SortedFile();
+
+  // return the next record in sorted order.  the record is valid until
+  // the next call.  returns FILEEOF after the last record
+  const Status next(Record & rec);
+
+  // write the records not yet returned by next to a new heap file
+  const Status writeFile(const string & fileName);
+
+  // number of runs made by run generation
+  const int getRunCnt() const { return runCnt; }
+
+  // number of merge passes, including the final one done by next()
+  const int getPassCnt() const { return passCnt; }
+
+ private:
+  struct SortEntry {
+    unsigned long long prefix;	// normalized key prefix
+    const char*	data;		// record in the workspace
+    int		length;
+  };
+
+  // a run, with the rid and key of the first record on each of its
+  // pages.  the key is empty if the record has none
+  struct Run {
+    string	name;
+    vector<RID>	fenceRids;
+    vector<string> fenceKeys;
+  };
+
+  // a merge: one scan per input run with its current record (data is
+  // NULL once the run is used up), and the loser tree over them.  only
+  // the keys in [lower, upper) are merged; an empty bound is no bound
+  struct Merge {
+    vector<HeapFileScan*> inputs;
+    vector<Record> cur;
+    vector<int>	tree;		// tree[0] is the winner
+    bool	advance;	// winner has been returned by next
+    string	lower;
+    string	upper;
+  };
+
+  int		offset;		// sort attribute
+  int		length;
+  Datatype	type;
+  int		threads;
+  int		fanIn;		// runs merged at a time by a thread
+
+  char*		workspace;	// run generation memory, wsSize bytes
+  int		wsSize;		// for each thread
+  SortEntry*	memRecs;	// sorted records of an input that fit in
+  int		memCnt;		// the workspace, served by next()
+  int		memNext;
+
+  int		sortNo;		// names the runs of this sort
+  int		runNo;		// number of runs named so far
+  mutex		runLock;	// guards runNo and runs
+  vector<Run>	runs;		// runs waiting to be merged
+  int		runCnt;
+  int		passCnt;
+
+  Merge		merge;		// last merge of a single threaded sort
+  vector<string> parts;		// key range partitions of a parallel sort
+  int		partNo;		// partition read by next()
+  HeapFileScan*	partScan;
+
+  const Status init(const int offset, const int length,
+		    const Datatype type, const int maxPages,
+		    const int threads);
+
+  // the key of a record, or NULL if the record is too short
+  const char* key(const char* rec, const int len) const;
+
+  // < 0, 0 or > 0 as key a is less than, equal to or greater than key
+  // b, where a NULL key is less than any other
+  const int compareKey(const char* a, const char* b) const;
+  const int compare(const char* a, const int alen,
+		    const char* b, const int blen) const;
+  const unsigned long long prefix(const char* key) const;
+
+  // run work(t) for t = 0 .. threads-1, each in a thread of its own
+  const Status runThreads(const function<const Status(const int)> & work);
+
+  const Status generateRuns(HeapFileScan & input, char* ws,
+			    const bool inMemory);
+  SortEntry* sortWorkspace(SortEntry* first, SortEntry* scratch,
+			   const int n) const;
+  const Status writeRun(const SortEntry* first, const int n);
+  const Status addRecord(InsertFileScan* ifs, Run & run,
+			 const Record & rec) const;
+  const string runName();
+
+  const Status mergeRuns();
+  const Status mergeGroup(const int first, const int cnt, Run & out);
+  const Status partition();
+  const Status nextPart(Record & rec);
+
+  const Status openMerge(Merge & m, const int first, const int cnt);
+  const Status closeMerge(Merge & m);
+  const Status nextRun(Merge & m, const int i, const RID* start = NULL);
+  const bool beats(const Merge & m, const int a, const int b) const;
+  void adjust(Merge & m, int s);
+  const Status nextMerged(Merge & m, Record & rec);
+};
+
+// The first k records returned by a HeapFileScan in the order of the
+// attribute [offset, offset+length) of the given type, smallest first,
+// or largest first with descending set: ORDER BY ... LIMIT k.  Records
+// with equal keys come in input order, and records too short to hold
+// the key are left out.
+//
+// A single pass is made over the input.  The best k records so far are
+// kept in a bounded heap whose root is the worst of them, as entries
+// of the key and the RID of the record, and with projections the
+// projected attributes packed as by scanProject.  Once the heap is
+// full, the key of the root is set as a bound on the scan (see
+// HeapFileScan::setBound) and kept up to date as the root changes, so
+// that the scan rejects the records that cannot make it, most of a
+// large input, before they reach the heap.
+
+class TopK {
+ public:
+  // keep the first k records of input.  the scan is run to its end
+  TopK(HeapFileScan & input,
+       const int offset,
+       const int length,
+       const Datatype type,
+       const bool descending,
+       const int k,
+       const Projection proj[],
+       const int projCnt,
+       Status & status);
+
+  // return the next record in order and its RID.  with projections the
+  // record is the projected attributes, otherwise it is read through
+  // input, which must still be open.  the record is valid until the
+  // next call.  returns FILEEOF after the last record
+  const Status next(Record & rec, RID & rid);
+
+  // records the scan returned, those the bound did not reject
+  const int getCandidateCnt() const { return candidateCnt; }
+
+ private:
+  HeapFileScan*	input;
+  int		offset;		// sort attribute
+  int		length;
+  Datatype	type;
+  bool		descending;
+  vector<Projection> proj;
+  int		width;		// of the projected attributes
+
+  int		entrySize;	// an entry: the key, then the projections
+  vector<char>	entries;
+  vector<RID>	rids;		// of the record of each entry
+  vector<int>	seqs;		// and its position in the input
+  vector<int>	heap;		// entries, the worst first; then in order
+  vector<char>	bound;		// key of the worst entry, once full
+  unsigned	outNext;	// next entry of heap returned by next
+  int		candidateCnt;
+
+  const int compareKey(const char* a, const char* b) const;
+  // true if entry a comes before entry b
+  const bool before(const int a, const int b) const;
+};
+
+#endif
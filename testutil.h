@@ -0,0 +1,22 @@
+#ifndef TESTUTIL_H
+#define TESTUTIL_H
+
+#include <functional>
+#include "heapfile.h"
+
+// Helpers shared by the test programs other than testfile.
+
+// create fileName holding num records of recLen bytes.  each record is
+// zeroed and then filled in by fill, given its position in the input.
+// the file is of the given format; a PAX file has attrCnt attributes
+// of the lengths in attrLen
+void loadFile(const string & fileName, const int num, const int recLen,
+              const function<void(char* rec, const int i)> & fill,
+              const PageFormat format = SLOTTED, const int attrCnt = 0,
+              const int attrLen[] = NULL);
+
+// number of files named prefix.<n>.<m> in the current directory, the
+// temporary files that operators spill to
+int spillFiles(const string & prefix);
+
+#endif